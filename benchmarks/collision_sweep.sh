@@ -0,0 +1,22 @@
+#!/bin/sh
+# Run collisionStress at several ball counts and report the balls spawned and last measured FPS of each.
+# Usage: collision_sweep.sh <collisionStress executable> [seconds per run] [ball counts...]
+# Must be run from a directory containing assets/.
+
+exe=$1
+duration=${2:-10}
+if [ $# -ge 2 ]; then shift 2; else shift $#; fi
+sizes=${*:-"1000 4000 13400 30000"}
+
+if [ ! -x "$exe" ]; then
+    echo "Usage: $0 <collisionStress executable> [seconds per run] [ball counts...]" >&2
+    exit 1
+fi
+
+echo "balls,fps"
+for n in $sizes; do
+    output=$(timeout "$duration" "$exe" "$n")
+    balls=$(echo "$output" | sed -n 's/^Balls spawned: //p' | tail -n 1)
+    fps=$(echo "$output" | sed -n 's/^Current FPS: //p' | tail -n 1)
+    echo "${balls:-n/a},${fps:-n/a}"
+done
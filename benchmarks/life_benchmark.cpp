@@ -0,0 +1,112 @@
+/*
+Benchmarks of cellular automaton generation stepping and RLE pattern parsing.
+*/
+#include <benchmark/benchmark.h>
+#include "life.h"
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+
+// Grid with roughly a third of cells alive, seeded for repeatable runs
+static LifeGrid randomGrid(int size)
+{
+    LifeGrid grid(size, size);
+    std::mt19937 rng(42);
+    for (int r = 0; r < size; ++r)
+    {
+        for (int c = 0; c < size; ++c)
+        {
+            grid.set(r, c, rng() % 3 == 0);
+        }
+    }
+    return grid;
+}
+
+// Encode a random square pattern as RLE text
+static std::string randomRLE(int size)
+{
+    std::mt19937 rng(42);
+    std::ostringstream out;
+    out << "x = " << size << ", y = " << size << ", rule = b3/s23\n";
+    for (int r = 0; r < size; ++r)
+    {
+        int c = 0;
+        while (c < size)
+        {
+            bool alive = rng() % 3 == 0;
+            int run = 1 + rng() % 8;
+            run = std::min(run, size - c);
+            if (run > 1)
+            {
+                out << run;
+            }
+            out << (alive ? 'o' : 'b');
+            c += run;
+        }
+        out << (r == size - 1 ? "!\n" : "$\n");
+    }
+    return out.str();
+}
+
+// Second argument pins the number of threads stepping the grid, 0 lets LifeGrid choose
+static void BM_LifeStep(benchmark::State& state, const std::string& rule)
+{
+    int size = static_cast<int>(state.range(0));
+    LifeGrid grid = randomGrid(size);
+    grid.setRule(parseRule(rule));
+    grid.setThreadCount(static_cast<int>(state.range(1)));
+    for (auto _ : state)
+    {
+        grid.step();
+    }
+    state.SetItemsProcessed(state.iterations() * size * size);
+}
+BENCHMARK_CAPTURE(BM_LifeStep, Life, std::string("B3/S23"))
+    ->ArgNames({ "size", "threads" })->ArgsProduct({ { 256, 1024, 4096 }, { 0, 1, 4 } })
+    ->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_LifeStep, HighLife, std::string("B36/S23"))
+    ->ArgNames({ "size", "threads" })->Args({ 1024, 0 })->Args({ 1024, 1 })
+    ->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_LifeStep, BriansBrain, std::string("B2/S/C3"))
+    ->ArgNames({ "size", "threads" })->Args({ 1024, 0 })->Args({ 1024, 1 })
+    ->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_LifeStep, Bosco, std::string("R5,C0,M1,S34..58,B34..45,NM"))
+    ->ArgNames({ "size", "threads" })->Args({ 1024, 0 })->Args({ 1024, 1 })
+    ->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+static void BM_ParseRLE(benchmark::State& state)
+{
+    std::string text = randomRLE(static_cast<int>(state.range(0)));
+    for (auto _ : state)
+    {
+        std::istringstream in(text);
+        benchmark::DoNotOptimize(parseRLE(in));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_ParseRLE)->RangeMultiplier(4)->Range(64, 1024)->Unit(benchmark::kMicrosecond);
+
+static void BM_ParseRLEAsset(benchmark::State& state)
+{
+    std::ifstream file(PONG_ASSETS_DIR "/rats.rle");
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+    if (text.empty())
+    {
+        state.SkipWithError("Unable to open assets/rats.rle");
+        return;
+    }
+
+    for (auto _ : state)
+    {
+        std::istringstream in(text);
+        benchmark::DoNotOptimize(parseRLE(in));
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_ParseRLEAsset)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -4,15 +4,20 @@ Stress test of SimpleECS collision system.
 Kewei Han
 */
 #include <SimpleECS_Core.h>
+#include "startup.h"
 #include <iostream>
 #include <cstdlib>
 #include <vector>
 #include <string>
 #include <memory>
+#include <climits>
 
 using namespace std;
 using namespace SimpleECS;
 
+// Asset paths
+const string FONT_FILE		= "assets/bit9x9.ttf";
+
 // Environment parameters
 const int SCREEN_HEIGHT		= 720;
 const int SCREEN_WIDTH		= 1280;
@@ -66,6 +71,9 @@ public:
 			displayFrames = frameCount;
 			frameCount = 0;
 			prevSecond = currSecond;
+
+			// Also report on stdout so benchmarks/collision_sweep.sh can collect it
+			cout << "Current FPS: " << displayFrames << endl;
 		};
 		
 		string text = "Current FPS: " + std::to_string(displayFrames);
@@ -114,7 +122,7 @@ public:
 Entity* createObjCounter(int num)
 {
 	Entity* counter = mainScene->createEntity();
-	counter->addComponent<FontRenderer>("Default", "assets/bit9x9.ttf", 26, Color(124, 200, 211, 0xff));
+	counter->addComponent<FontRenderer>("Default", FONT_FILE, 26, Color(124, 200, 211, 0xff));
 	counter->addComponent<ObjectCounter>(num);
 	return counter;
 }
@@ -122,7 +130,7 @@ Entity* createObjCounter(int num)
 Entity* createCurrFramesCounter()
 {
 	Entity* counter = mainScene->createEntity();
-	counter->addComponent<FontRenderer>("Default", "assets/bit9x9.ttf", 26, Color(124, 200, 211, 0xff));
+	counter->addComponent<FontRenderer>("Default", FONT_FILE, 26, Color(124, 200, 211, 0xff));
 	counter->addComponent<CurrFrameCounter>();
 	return counter;
 }
@@ -130,7 +138,7 @@ Entity* createCurrFramesCounter()
 Entity* createFramesCounter()
 {
 	Entity* counter = mainScene->createEntity();
-	counter->addComponent<FontRenderer>("Default", "assets/bit9x9.ttf", 26, Color(124, 200, 211,0xff));
+	counter->addComponent<FontRenderer>("Default", FONT_FILE, 26, Color(124, 200, 211,0xff));
 	counter->addComponent<AvgFrameCounter>();
 	return counter;
 }
@@ -138,7 +146,7 @@ Entity* createFramesCounter()
 Entity* createTimeCounter()
 {
 	Entity* counter = mainScene->createEntity();
-	counter->addComponent<FontRenderer>("Default", "assets/bit9x9.ttf", 26, Color(124, 200, 211, 0xff));
+	counter->addComponent<FontRenderer>("Default", FONT_FILE, 26, Color(124, 200, 211, 0xff));
 	counter->addComponent<TimeCounter>();
 	return counter;
 }
@@ -212,7 +220,7 @@ int spawnBalls(const int& numRow, const int& numColumn, const int& num)
 
 	for (int i = 0; i < numRow && numSpawned < num; ++i)
 	{
-		for (int j = 0; j < numColumn; ++j)
+		for (int j = 0; j < numColumn && numSpawned < num; ++j)
 		{
 			Entity* newBall = createBall(xSpawnPos, ySpawnPos);
 			xSpawnPos += columnSpacing;
@@ -226,13 +234,27 @@ int spawnBalls(const int& numRow, const int& numColumn, const int& num)
 	return numSpawned;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
 	try
 	{
 		cout << "Hello World!" << endl;
 
 		srand(RAND_SEED);
 
+		// Number of balls can be overridden to run scenes of different sizes
+		int numBalls = NUM_BALLS;
+		if (argc > 1)
+		{
+			char* end = nullptr;
+			long requested = strtol(argv[1], &end, 10);
+			if (end == argv[1] || *end != '\0' || requested < 1 || requested > INT_MAX)
+			{
+				cout << "Usage: " << argv[0] << " [number of balls, at least 1]" << endl;
+				return 1;
+			}
+			numBalls = static_cast<int>(requested);
+		}
+
 		// Create scene
 		mainScene = new Scene(Color(0, 0, 0, 255));
 
@@ -240,14 +262,18 @@ int main() {
 		addBounds();
 
 		// Get a grid of squares
-		int columns = ceil(sqrt(NUM_BALLS / ((double)SCREEN_HEIGHT / (double)SCREEN_WIDTH)));
-		int rows = ceil(NUM_BALLS / columns);
-		int numSpawned = spawnBalls(rows, columns, NUM_BALLS);
+		int columns = ceil(sqrt(numBalls / ((double)SCREEN_HEIGHT / (double)SCREEN_WIDTH)));
+		int rows = std::max(1, (int)ceil((double)numBalls / columns));
+		int numSpawned = spawnBalls(rows, columns, numBalls);
+		cout << "Balls spawned: " << numSpawned << endl;
+		logStartupStage("Balls spawned");
 
 		createCurrFramesCounter();
 		createFramesCounter();
 		createTimeCounter();
 		createObjCounter(numSpawned);
+		mainScene->createEntity()->addComponent<FirstFrameLogger>();
+		logStartupStage("Counters created");
 
 		// Create game with scene
 		Game::getInstance().configureWindow(SCREEN_WIDTH, SCREEN_HEIGHT);
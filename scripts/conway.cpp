@@ -4,198 +4,84 @@ Stress test of SimpleECS collision system.
 Kewei Han
 */
 #include <SimpleECS_Core.h>
+#include "life.h"
+#include "startup.h"
 #include <iostream>
 #include <cstdlib>
 #include <vector>
 #include <string>
 #include <memory>
-#include <sstream>
-#include <fstream>
+#include <future>
 
 using namespace std;
 using namespace SimpleECS;
 
 const string RLE_PATH = "assets/rats.rle";
+const string FONT_FILE = "assets/bit9x9.ttf";
 const int SCREEN_HEIGHT = 960;
 const int SCREEN_WIDTH = 1280;
 const int CELL_SIZE = 1; // SIZE in pixels of visible cells
 
 const double GEN_LENGTH = 0.05; // Time in seconds per generation
 
-std::vector<bool> parseRLELine(const std::string& line) {
-    std::vector<bool> row;
-    int count = 0;
-
-    for (char c : line) {
-        if (isdigit(c)) {
-            count = count * 10 + (c - '0');
-        }
-        else {
-            if (c == '!') { break; }
-            if (c == '\n') { continue; }
-            bool state = (c == 'o');
-            for (int i = 0; i < max(1, count); ++i) {
-                row.push_back(state);
-            }
-            count = 0;
-        }
-    }
-    return row;
-}
-
-std::vector<std::vector<bool>> parseRLE(const std::string& filePath) {
-    std::ifstream file(filePath.c_str());
-
-    if (!file.is_open()) {
-        std::cerr << "Unable to open file.\n";
-        exit(1); // exit with error code
-    }
-
-    // Skip headers
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line[0] == 'x') {
-            break;
-        }
-    }
-
-    int x, y;
-    sscanf_s(line.c_str(), "x = %d, y = %d", &x, &y); // parse the size of the grid
-
-    std::vector<std::vector<bool>> grid; // create a 2D array
-
-    int row = 0, col = 0;
-    std::string cellData;
-    while (std::getline(file, cellData, '$')) {
-
-        int numEmpties = 0;
-        if (isdigit(cellData.back())) {
-            numEmpties = cellData.back() - '0' - 1;
-            cellData.pop_back();
-        }
-
-        // Parse the remaining line
-        if (!cellData.empty()) {
-            grid.push_back(parseRLELine(cellData));
-        }
-
-        for (int i = 0; i < numEmpties; ++i) {
-            grid.push_back(std::vector<bool>());
-        }
-  
-    }
-
-    file.close();
-    std::reverse(grid.begin(), grid.end());
-    return grid;
-}
-
-// Component for controlling paddle movement manually
-class Cell : public Component {
+// Component for creating cell entities and advancing generations. Cells that did
+// not change in a generation are left alone, only changed cells update their renderer.
+class CellManager : public Component {
 public:
     static int viewGridWidth;
     static int viewGridHeight;
     static int cellSize;
-    static vector<vector<bool>> cells;
-
-    Cell(int _r, int _c) : r(_r), c(_c) {}
-    
-    void initialize() 
-    {
-        double xPos = c * cellSize - SCREEN_WIDTH / 2;
-        double yPos = r * cellSize - SCREEN_HEIGHT / 2;
-        entity->transform->position = { xPos, yPos };
-        rr = entity->getComponent<RectangleRenderer>();
-    }
+    static LifeGrid grid;
 
-    void update() override
-    {
-        rr->setActive(cells[r][c]);
-    }
+    // Grid is parsed on a background thread while the game starts up, and only waited on here
+    CellManager(std::shared_future<RLEPattern> _pattern): patternLoad(_pattern) {}
 
-    void calcNextGen()
+    void initialize()
     {
-        // conway rules - 23/3
-        
-        // get number of neighbors
-        int liveNeighbors = 0;
-        for (int dr = -1; dr <= 1; ++dr) {
-            for (int dc = -1; dc <= 1; ++dc) {
-                if (dr != 0 || dc != 0) {  // Exclude the cell itself
-                    // Toridial neighbor calculation to handle edges
-                    int nr = (r + dr + cells.size()) % cells.size();
-                    int nc = (c + dc + cells[0].size()) % cells[0].size();
-                    liveNeighbors += cells[nr][nc] ? 1 : 0;
-                }
-            }
-        }
-
-        // Any live cell with fewer than two live neighbors dies, as if by underpopulation.
-        if (cells[r][c] && liveNeighbors < 2)
-        {
-            nextGenActive = false;
-        }
-        // Any live cell with two or three live neighbors lives on to the next generation.
-        else if (cells[r][c] && (liveNeighbors == 3 || liveNeighbors == 2))
+        // Errors from background parse are rethrown here, and reported from game thread
+        const RLEPattern* pattern = nullptr;
+        try
         {
-            nextGenActive = true;
+            pattern = &patternLoad.get();
         }
-        // Any live cell with more than three live neighbors dies, as if by overpopulation.
-        else if (cells[r][c] && liveNeighbors > 3)
+        catch (const std::exception& e)
         {
-            nextGenActive = false;
+            std::cerr << "Unable to load " << RLE_PATH << ": " << e.what() << std::endl;
+            exit(1); // exit with error code
         }
-        // Any dead cell with exactly three live neighbors becomes a live cell, as if by reproduction.
-        else if (!cells[r][c] && liveNeighbors == 3)
-        {
-            nextGenActive = true;
-        }
-    }
-
-    void transitionNextGen()
-    {
-        cells[r][c] = nextGenActive;
-    }
-
-private:
-    int r, c;
-    bool nextGenActive = false;
-    Handle<RectangleRenderer> rr;
-};
-
-int Cell::viewGridWidth             = SCREEN_WIDTH / CELL_SIZE;
-int Cell::viewGridHeight            = SCREEN_HEIGHT / CELL_SIZE;
-int Cell::cellSize                  = CELL_SIZE;
-vector<vector<bool>> Cell::cells    = vector<vector<bool>>(viewGridHeight + 1, vector<bool>(viewGridWidth + 1, false));
-
-class CellManager : public Component {
-public:
-    CellManager(vector<vector<bool>>& _parsedGrid): parsedGrid(_parsedGrid) {}
+        const vector<vector<uint8_t>>& parsedGrid = pattern->cells;
+        grid.setRule(pattern->rule);
+        logStartupStage("Pattern parsed");
 
-    void initialize()
-    {
-        // Create entities from parsedGrid
-        auto scene = Game::getInstance().getCurrentScene();
-        for (int r = 0; r < Cell::viewGridHeight + 1; r++)
+        // Copy parsedGrid into center of scene grid
+        int top = (grid.rows - parsedGrid.size()) / 2;
+        int left = (grid.cols - parsedGrid[0].size()) / 2;
+        for (int r = top, i = 0; r < grid.rows && i < parsedGrid.size(); ++r, ++i)
         {
-            for (int c = 0; c < Cell::viewGridWidth + 1; c++)
+            for (int c = left, j = 0; c < grid.cols && j < parsedGrid[i].size(); ++c, ++j)
             {
-                auto cellEnt = scene->createEntity();
-                cellEnt->addComponent<RectangleRenderer>(CELL_SIZE, CELL_SIZE, Color(0xFF, 0xFF, 0xFF));
-                cellEnt->addComponent<Cell>(r, c);
+                grid.set(r, c, parsedGrid[i][j]);
             }
         }
 
-        // Copy parsedGrid into center of scene grid
-        int top = (Cell::cells.size() - parsedGrid.size()) / 2;
-        int left = (Cell::cells[0].size() - parsedGrid[0].size()) / 2;
-        for (int r = top, i = 0; r < Cell::cells.size() && i < parsedGrid.size(); ++r, ++i)
+        // Create cell entities matching grid
+        auto scene = Game::getInstance().getCurrentScene();
+        renderers.reserve(grid.rows * grid.cols);
+        for (int r = 0; r < grid.rows; r++)
         {
-            for (int c = left, j = 0; c < Cell::cells[0].size() && j < parsedGrid[i].size(); ++c, ++j)
+            for (int c = 0; c < grid.cols; c++)
             {
-                Cell::cells[r][c] = parsedGrid[i][j];
+                auto cellEnt = scene->createEntity();
+                double xPos = c * cellSize - SCREEN_WIDTH / 2;
+                double yPos = r * cellSize - SCREEN_HEIGHT / 2;
+                cellEnt->transform->position = { xPos, yPos };
+
+                auto rr = cellEnt->addComponent<RectangleRenderer>(CELL_SIZE, CELL_SIZE, Color(0xFF, 0xFF, 0xFF));
+                rr->setActive(grid.get(r, c) == 1);
+                renderers.push_back(rr);
             }
         }
+        logStartupStage("Cells created");
     }
 
     void update() override
@@ -204,17 +90,10 @@ public:
         if (timer >= GEN_LENGTH * 1000)
         {
             timer = 0;
-            auto scene = Game::getInstance().getCurrentScene();
-            for (auto& cell : *scene->getComponents<Cell>())
-            {
-                cell.calcNextGen();
-            }
-
-            for (auto& cell : *scene->getComponents<Cell>())
-            {
-                cell.transitionNextGen();
-            }
-
+            grid.step();
+            grid.forEachChanged([this](int i, uint8_t state) {
+                renderers[i]->setActive(state == 1);
+            });
             generation++;
         }
     }
@@ -223,9 +102,14 @@ public:
 
 private: 
     double timer = 0;
-    vector<vector<bool>> parsedGrid;
+    std::shared_future<RLEPattern> patternLoad;
+    vector<Handle<RectangleRenderer>> renderers; // Indexed as grid cells
 };
 
+int CellManager::viewGridWidth      = SCREEN_WIDTH / CELL_SIZE;
+int CellManager::viewGridHeight     = SCREEN_HEIGHT / CELL_SIZE;
+int CellManager::cellSize           = CELL_SIZE;
+LifeGrid CellManager::grid          = LifeGrid(viewGridHeight + 1, viewGridWidth + 1);
 int CellManager::generation = 0;
 
 class GenerationCounter : public Component {
@@ -268,9 +152,9 @@ public:
 
 
 int main() {
-    auto parsedGrid = parseRLE(RLE_PATH);
+    std::shared_future<RLEPattern> pattern = std::async(std::launch::async, []() { return parseRLE(RLE_PATH); });
      //print the grid
-     //for (const auto& row : parsedGrid) {
+     //for (const auto& row : pattern.get().cells) {
      //    for (bool cell : row) {
      //        std::cout << (cell ? 'o' : 'b');
      //    }
@@ -279,16 +163,18 @@ int main() {
     // Create Scene
     Scene* scene = new Scene(Color(0, 0, 0, 255));
     Game::getInstance().addScene(scene);
-    scene->createEntity()->addComponent<CellManager>(parsedGrid);
+    scene->createEntity()->addComponent<CellManager>(pattern);
     
     auto genDisplay = scene->createEntity();
-    genDisplay->addComponent<FontRenderer>("Default", "assets/bit9x9.ttf", 26, Color(124, 200, 211, 0xff));
+    genDisplay->addComponent<FontRenderer>("Default", FONT_FILE, 26, Color(124, 200, 211, 0xff));
     genDisplay->addComponent<GenerationCounter>();
 
     auto framesDisplay = scene->createEntity();
-    framesDisplay->addComponent<FontRenderer>("Default", "assets/bit9x9.ttf", 26, Color(124, 200, 211, 0xff));
+    framesDisplay->addComponent<FontRenderer>("Default", FONT_FILE, 26, Color(124, 200, 211, 0xff));
     framesDisplay->addComponent<AvgFrameCounter>();
 
+    scene->createEntity()->addComponent<FirstFrameLogger>();
+
     // TODO: fix this bug. If BoxCollider isn't present library crashses.
     auto dummy = scene->createEntity();
     dummy->addComponent<BoxCollider>();
@@ -296,7 +182,6 @@ int main() {
     // TODO: fix this bug. If addComponent for a type is first called in initialize, there is
     // potential for a crash (due to vector invalidation)
     dummy->addComponent<RectangleRenderer>(0,0);
-    dummy->addComponent<Cell>(0, 0);
 
     Game::getInstance().configureWindow(SCREEN_WIDTH, SCREEN_HEIGHT);
     Game::getInstance().startGame();
@@ -0,0 +1,569 @@
+#include "life.h"
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+// Largest Larger than Life neighborhood radius, as commonly supported
+constexpr int MAX_RANGE = 500;
+
+// Toroidal index wrap, handling negative indices
+inline int wrap(int i, int n)
+{
+    return ((i % n) + n) % n;
+}
+
+std::vector<std::string> split(const std::string& text, char delim)
+{
+    std::vector<std::string> tokens(1);
+    for (char c : text) {
+        if (c == delim) {
+            tokens.emplace_back();
+        }
+        else {
+            tokens.back() += c;
+        }
+    }
+    return tokens;
+}
+
+bool isNumber(const std::string& text)
+{
+    return std::all_of(text.begin(), text.end(), [](char c) { return isdigit(c); });
+}
+
+int parseCount(const std::string& text, const std::string& rulestring)
+{
+    if (text.empty() || !isNumber(text)) {
+        throw std::invalid_argument("Invalid rule: " + rulestring);
+    }
+    try {
+        return std::stoi(text);
+    }
+    catch (const std::out_of_range&) {
+        throw std::invalid_argument("Invalid rule: " + rulestring);
+    }
+}
+
+// Add counts of a Larger than Life "min..max" range or single count
+void addCountRange(const std::string& text, std::vector<int>& counts, const std::string& rulestring)
+{
+    size_t dots = text.find("..");
+    if (dots == std::string::npos) {
+        counts.push_back(parseCount(text, rulestring));
+        return;
+    }
+
+    int low = parseCount(text.substr(0, dots), rulestring);
+    int high = parseCount(text.substr(dots + 2), rulestring);
+    for (int n = low; n <= high; ++n) {
+        counts.push_back(n);
+    }
+}
+
+// Add each digit as a count, as in B/S notation
+void addCountDigits(const std::string& text, std::vector<int>& counts, const std::string& rulestring)
+{
+    for (char c : text) {
+        if (!isdigit(c)) {
+            throw std::invalid_argument("Invalid rule: " + rulestring);
+        }
+        counts.push_back(c - '0');
+    }
+}
+
+// Larger than Life notation, e.g. R5,C0,M1,S34..58,B34..45,NM
+void parseRangeRule(const std::string& text, LifeRule& rule, std::vector<int>& birthCounts, std::vector<int>& surviveCounts)
+{
+    std::vector<int>* lastCounts = nullptr;
+    for (const auto& token : split(text, ',')) {
+        if (token.empty()) {
+            throw std::invalid_argument("Invalid rule: " + text);
+        }
+
+        // Further counts of a previous S or B list
+        if (isdigit(token[0]) && lastCounts) {
+            addCountRange(token, *lastCounts, text);
+            continue;
+        }
+
+        char key = toupper(token[0]);
+        std::string value = token.substr(1);
+        lastCounts = nullptr;
+        if (key == 'R') {
+            rule.range = parseCount(value, text);
+        }
+        else if (key == 'C') {
+            rule.states = std::max(2, parseCount(value, text));
+        }
+        else if (key == 'M') {
+            rule.countMiddle = parseCount(value, text) != 0;
+        }
+        else if (key == 'S' || key == 'B') {
+            lastCounts = key == 'S' ? &surviveCounts : &birthCounts;
+            if (!value.empty()) {
+                addCountRange(value, *lastCounts, text);
+            }
+        }
+        else if (key == 'N' && value.size() == 1 && (toupper(value[0]) == 'M' || toupper(value[0]) == 'N')) {
+            rule.vonNeumann = toupper(value[0]) == 'N';
+        }
+        else {
+            throw std::invalid_argument("Invalid rule: " + text);
+        }
+    }
+}
+
+// B/S, S/B and Generations notations, e.g. B3/S23, 23/3, B2/S/C3, /2/3
+void parseTotalisticRule(const std::string& text, LifeRule& rule, std::vector<int>& birthCounts, std::vector<int>& surviveCounts)
+{
+    std::vector<std::string> tokens = split(text, '/');
+    if (std::all_of(tokens.begin(), tokens.end(), isNumber)) {
+        // Survival and birth counts, then optional number of states
+        if (tokens.size() < 2 || tokens.size() > 3) {
+            throw std::invalid_argument("Invalid rule: " + text);
+        }
+        addCountDigits(tokens[0], surviveCounts, text);
+        addCountDigits(tokens[1], birthCounts, text);
+        if (tokens.size() == 3) {
+            rule.states = parseCount(tokens[2], text);
+        }
+        return;
+    }
+
+    for (const auto& token : tokens) {
+        if (!token.empty() && isNumber(token)) {
+            rule.states = parseCount(token, text);
+            continue;
+        }
+
+        char key = token.empty() ? '\0' : toupper(token[0]);
+        std::string value = token.empty() ? "" : token.substr(1);
+        if (key == 'B') {
+            addCountDigits(value, birthCounts, text);
+        }
+        else if (key == 'S') {
+            addCountDigits(value, surviveCounts, text);
+        }
+        else if (key == 'C' || key == 'G') {
+            rule.states = parseCount(value, text);
+        }
+        else {
+            throw std::invalid_argument("Invalid rule: " + text);
+        }
+    }
+}
+
+} // namespace
+
+int LifeRule::maxNeighbors() const
+{
+    return vonNeumann ? 2 * range * (range + 1) : (2 * range + 1) * (2 * range + 1) - 1;
+}
+
+LifeRule parseRule(const std::string& rulestring)
+{
+    std::string text;
+    for (char c : rulestring) {
+        if (!isspace(c)) {
+            text += c;
+        }
+    }
+    if (text.empty()) {
+        throw std::invalid_argument("Empty rule");
+    }
+
+    LifeRule rule;
+    std::vector<int> birthCounts, surviveCounts;
+    if (text.find(',') != std::string::npos) {
+        parseRangeRule(text, rule, birthCounts, surviveCounts);
+    }
+    else {
+        parseTotalisticRule(text, rule, birthCounts, surviveCounts);
+    }
+
+    if (rule.range < 1 || rule.range > MAX_RANGE || rule.states < 2 || rule.states > 256) {
+        throw std::invalid_argument("Unsupported rule: " + rulestring);
+    }
+
+    // A live cell counting itself can reach one above neighborhood size
+    int maxCount = rule.maxNeighbors() + (rule.countMiddle ? 1 : 0);
+    rule.birth.assign(maxCount + 1, false);
+    rule.survive.assign(maxCount + 1, false);
+    for (int n : birthCounts) {
+        if (n > maxCount) {
+            throw std::invalid_argument("Neighbor count out of range: " + rulestring);
+        }
+        rule.birth[n] = true;
+    }
+    for (int n : surviveCounts) {
+        if (n > maxCount) {
+            throw std::invalid_argument("Neighbor count out of range: " + rulestring);
+        }
+        rule.survive[n] = true;
+    }
+    return rule;
+}
+
+RLEPattern parseRLE(std::istream& in) {
+    RLEPattern pattern;
+    pattern.rule = parseRule("B3/S23");
+
+    // Skip comments and read header
+    int width = 0, height = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line[0] == 'x') {
+            std::sscanf(line.c_str(), "x = %d, y = %d", &width, &height); // parse the size of the grid
+
+            size_t ruleKey = line.find("rule");
+            size_t equals = ruleKey == std::string::npos ? ruleKey : line.find('=', ruleKey);
+            if (equals != std::string::npos) {
+                pattern.rule = parseRule(line.substr(equals + 1));
+            }
+            break;
+        }
+    }
+
+    // Decode runs of cell states, rows are separated by '$'
+    std::vector<std::vector<uint8_t>>& grid = pattern.cells;
+    grid.emplace_back();
+    int count = 0;
+    int prefix = 0;
+    char c;
+    while (in.get(c) && c != '!') {
+        if (isdigit(c)) {
+            count = count * 10 + (c - '0');
+            continue;
+        }
+        // Multi-state prefix, pA..yX encode states above 24
+        if (c >= 'p' && c <= 'y') {
+            prefix = c - 'p' + 1;
+            continue;
+        }
+        if (isspace(c)) {
+            continue;
+        }
+
+        int run = std::max(1, count);
+        count = 0;
+        if (c == '$') {
+            for (int i = 0; i < run; ++i) {
+                grid.emplace_back();
+            }
+            continue;
+        }
+
+        int state = 0;
+        if (c == 'o') {
+            state = 1;
+        }
+        else if (c >= 'A' && c <= 'X') {
+            state = prefix * 24 + (c - 'A' + 1);
+        }
+        prefix = 0;
+
+        // States the rule does not have are treated as live
+        if (state >= pattern.rule.states) {
+            state = 1;
+        }
+        grid.back().insert(grid.back().end(), run, static_cast<uint8_t>(state));
+    }
+
+    // Pad to declared size, RLE omits trailing dead cells and rows
+    while (static_cast<int>(grid.size()) < height) {
+        grid.emplace_back();
+    }
+    for (const auto& row : grid) {
+        width = std::max(width, static_cast<int>(row.size()));
+    }
+    for (auto& row : grid) {
+        row.resize(width, 0);
+    }
+
+    std::reverse(grid.begin(), grid.end());
+    return pattern;
+}
+
+RLEPattern parseRLE(const std::string& filePath) {
+    std::ifstream file(filePath.c_str());
+
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open file: " + filePath);
+    }
+
+    return parseRLE(file);
+}
+
+// Threads kept alive across generations. Each runs its own chunk of a task once per run().
+class LifeGrid::Workers {
+public:
+    explicit Workers(int count)
+    {
+        for (int i = 1; i <= count; ++i)
+        {
+            threads.emplace_back(&Workers::work, this, i);
+        }
+    }
+
+    ~Workers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        start.notify_all();
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    int size() const { return static_cast<int>(threads.size()); }
+
+    // Run task(1..size()) on workers and task(0) on calling thread, returning once all are done
+    void run(const std::function<void(int)>& _task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = &_task;
+            pending = size();
+            ++generation;
+        }
+        start.notify_all();
+        _task(0);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return pending == 0; });
+        task = nullptr;
+    }
+
+private:
+    void work(int chunk)
+    {
+        uint64_t seen = 0;
+        while (true)
+        {
+            const std::function<void(int)>* current;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                start.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping)
+                {
+                    return;
+                }
+                seen = generation;
+                current = task;
+            }
+
+            (*current)(chunk);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0)
+            {
+                done.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable done;
+    const std::function<void(int)>* task = nullptr;
+    uint64_t generation = 0;
+    int pending = 0;
+    bool stopping = false;
+};
+
+LifeGrid::LifeGrid(int _rows, int _cols) : rows(_rows), cols(_cols),
+    cells(_rows * _cols, 0), next(_rows * _cols, 0)
+{
+    setRule(parseRule("B3/S23"));
+}
+
+LifeGrid::LifeGrid(LifeGrid&&) noexcept = default;
+LifeGrid& LifeGrid::operator=(LifeGrid&&) noexcept = default;
+LifeGrid::~LifeGrid() = default;
+
+void LifeGrid::setRule(const LifeRule& _rule)
+{
+    rule = _rule;
+    tableStride = rule.maxNeighbors() + 1;
+
+    auto contains = [](const std::vector<bool>& counts, int n) {
+        return n < static_cast<int>(counts.size()) && counts[n];
+    };
+    table.assign(rule.states * tableStride, 0);
+    for (int state = 0; state < rule.states; ++state)
+    {
+        for (int n = 0; n < tableStride; ++n)
+        {
+            uint8_t& nextState = table[state * tableStride + n];
+            if (state == 0)
+            {
+                nextState = contains(rule.birth, n) ? 1 : 0;
+            }
+            else if (state == 1)
+            {
+                // Cells that fail to survive start decaying in Generations rules
+                int count = n + (rule.countMiddle ? 1 : 0);
+                nextState = contains(rule.survive, count) ? 1 : (rule.states > 2 ? 2 : 0);
+            }
+            else
+            {
+                nextState = state + 1 < rule.states ? state + 1 : 0;
+            }
+        }
+    }
+
+    // Existing cells in states the rule does not have are treated as live
+    for (auto& state : cells)
+    {
+        if (state >= rule.states)
+        {
+            state = 1;
+        }
+    }
+}
+
+void LifeGrid::step()
+{
+    int numChunks = threadCount;
+    if (numChunks < 1)
+    {
+        // Waking workers costs more than stepping a small grid on one thread
+        numChunks = rows * cols < PARALLEL_MIN_CELLS ? 1 : static_cast<int>(std::thread::hardware_concurrency());
+    }
+    numChunks = std::max(1, std::min(numChunks, rows));
+    int chunkSize = (rows + numChunks - 1) / numChunks;
+    changed.resize(numChunks);
+
+    if (numChunks == 1)
+    {
+        stepRows(0, rows, 0);
+    }
+    else
+    {
+        if (!workers || workers->size() != numChunks - 1)
+        {
+            workers.reset();
+            workers = std::make_unique<Workers>(numChunks - 1);
+        }
+        workers->run([this, chunkSize](int chunk) {
+            int begin = std::min(rows, chunk * chunkSize);
+            stepRows(begin, std::min(rows, begin + chunkSize), chunk);
+        });
+    }
+    cells.swap(next);
+}
+
+void LifeGrid::stepRows(int begin, int end, int chunk)
+{
+    std::vector<int>& chunkChanged = changed[chunk];
+    chunkChanged.clear();
+    if (begin >= end)
+    {
+        return;
+    }
+
+    if (rule.range == 1 && !rule.vonNeumann)
+    {
+        if (rule.states == 2)
+        {
+            stepMooreRows<false>(begin, end, chunkChanged);
+        }
+        else
+        {
+            stepMooreRows<true>(begin, end, chunkChanged);
+        }
+    }
+    else
+    {
+        stepRangeRows(begin, end, chunkChanged);
+    }
+}
+
+template <bool Generations>
+void LifeGrid::stepMooreRows(int begin, int end, std::vector<int>& chunkChanged)
+{
+    // Decaying cells of Generations rules are not live neighbors
+    auto live = [](uint8_t state) -> int { return Generations ? state == 1 : state; };
+
+    for (int r = begin; r < end; ++r)
+    {
+        // Toroidal neighbor rows to handle edges
+        const uint8_t* up   = &cells[((r - 1 + rows) % rows) * cols];
+        const uint8_t* mid  = &cells[r * cols];
+        const uint8_t* down = &cells[((r + 1) % rows) * cols];
+        uint8_t* out = &next[r * cols];
+
+        for (int c = 0; c < cols; ++c)
+        {
+            int left  = c == 0 ? cols - 1 : c - 1;
+            int right = c == cols - 1 ? 0 : c + 1;
+            int liveNeighbors = live(up[left]) + live(up[c]) + live(up[right])
+                              + live(mid[left]) + live(mid[right])
+                              + live(down[left]) + live(down[c]) + live(down[right]);
+
+            out[c] = table[mid[c] * tableStride + liveNeighbors];
+            if (out[c] != mid[c])
+            {
+                chunkChanged.push_back(r * cols + c);
+            }
+        }
+    }
+}
+
+void LifeGrid::stepRangeRows(int begin, int end, std::vector<int>& chunkChanged)
+{
+    int range = rule.range;
+    int paddedCols = cols + 2 * range;
+    int stride = paddedCols + 1;
+
+    // Prefix sums of live cells along each row within range of chunk, padded with wrapped columns
+    int numRows = end - begin + 2 * range;
+    std::vector<int> prefix(numRows * stride);
+    for (int i = 0; i < numRows; ++i)
+    {
+        const uint8_t* row = &cells[wrap(begin - range + i, rows) * cols];
+        int* sums = &prefix[i * stride];
+        sums[0] = 0;
+        for (int x = 0; x < paddedCols; ++x)
+        {
+            sums[x + 1] = sums[x] + (row[wrap(x - range, cols)] == 1);
+        }
+    }
+
+    for (int r = begin; r < end; ++r)
+    {
+        const uint8_t* mid = &cells[r * cols];
+        uint8_t* out = &next[r * cols];
+
+        for (int c = 0; c < cols; ++c)
+        {
+            // Sum each row of neighborhood, narrowing toward top and bottom for diamond shape
+            int liveNeighbors = 0;
+            for (int dr = -range; dr <= range; ++dr)
+            {
+                int halfWidth = rule.vonNeumann ? range - std::abs(dr) : range;
+                const int* sums = &prefix[(r - begin + range + dr) * stride];
+                liveNeighbors += sums[c + range + halfWidth + 1] - sums[c + range - halfWidth];
+            }
+            liveNeighbors -= mid[c] == 1;
+
+            out[c] = table[mid[c] * tableStride + liveNeighbors];
+            if (out[c] != mid[c])
+            {
+                chunkChanged.push_back(r * cols + c);
+            }
+        }
+    }
+}
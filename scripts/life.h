@@ -0,0 +1,107 @@
+/*
+Cellular automaton grid, rules and RLE pattern parsing, independent of SimpleECS.
+*/
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Outer totalistic cellular automaton rule. Covers B/S rules, multi-state Generations
+// rules and Larger than Life neighborhoods.
+struct LifeRule {
+    int states = 2;             // Cell states, states above 1 are decaying cells of Generations rules
+    int range = 1;              // Neighborhood radius, above 1 for Larger than Life rules
+    bool vonNeumann = false;    // Diamond neighborhood if true, square (Moore) if false
+    bool countMiddle = false;   // Whether a live cell counts itself as a neighbor
+    std::vector<bool> birth;    // Indexed by live neighbor count
+    std::vector<bool> survive;  // Indexed by live neighbor count
+
+    // Number of cells in neighborhood, excluding the cell itself
+    int maxNeighbors() const;
+};
+
+// Parse rulestring in B/S (B3/S23), S/B (23/3), Generations (B2/S/C3, /2/3) or
+// Larger than Life (R5,C0,M1,S34..58,B34..45,NM) notation.
+// Throws std::invalid_argument if rulestring is malformed, or has a range above 500
+// or more than 256 states.
+LifeRule parseRule(const std::string& rulestring);
+
+// Pattern read from an RLE file
+struct RLEPattern {
+    std::vector<std::vector<uint8_t>> cells; // Cell states, bottom row first, rows padded to pattern width
+    LifeRule rule;                           // Rule from header, B3/S23 if not given
+};
+
+// Parse an RLE pattern and its rule. Throws std::invalid_argument if header rule is
+// malformed, and std::runtime_error if file cannot be opened.
+RLEPattern parseRLE(std::istream& in);
+RLEPattern parseRLE(const std::string& filePath);
+
+// Tightly packed, double-buffered grid of cell states. A generation is computed
+// over contiguous rows instead of walking every cell component in the scene.
+class LifeGrid {
+public:
+    LifeGrid(int _rows, int _cols);
+    LifeGrid(LifeGrid&&) noexcept;
+    LifeGrid& operator=(LifeGrid&&) noexcept;
+    ~LifeGrid();
+
+    uint8_t get(int r, int c) const { return cells[r * cols + c]; }
+
+    // States the rule does not have are treated as live, as in parseRLE
+    void set(int r, int c, uint8_t state) { cells[r * cols + c] = state < rule.states ? state : 1; }
+
+    // Set rule and compile it into a next state lookup table
+    void setRule(const LifeRule& _rule);
+    const LifeRule& getRule() const { return rule; }
+
+    // Advance one generation, splitting rows into chunks across worker threads.
+    // Grids below PARALLEL_MIN_CELLS are stepped on the calling thread.
+    void step();
+
+    // Number of row chunks stepped in parallel, including the calling thread.
+    // 0 picks hardware concurrency for large grids and 1 for small ones.
+    void setThreadCount(int count) { threadCount = count; }
+
+    static constexpr int PARALLEL_MIN_CELLS = 1 << 17;
+
+    // Call fn(index, state) for each cell that changed state in the last step
+    template <typename Fn>
+    void forEachChanged(Fn fn) const
+    {
+        for (const auto& chunk : changed)
+        {
+            for (int i : chunk)
+            {
+                fn(i, cells[i]);
+            }
+        }
+    }
+
+    int rows, cols;
+
+private:
+    class Workers;
+
+    void stepRows(int begin, int end, int chunk);
+
+    // Kernel for range 1 square neighborhoods, counting live neighbors directly
+    template <bool Generations>
+    void stepMooreRows(int begin, int end, std::vector<int>& chunkChanged);
+
+    // Kernel for any range or neighborhood shape, counting live neighbors with row prefix sums
+    void stepRangeRows(int begin, int end, std::vector<int>& chunkChanged);
+
+    LifeRule rule;
+    std::vector<uint8_t> table; // Next state, indexed by state * tableStride + live neighbors excluding self
+    int tableStride = 0;
+
+    std::vector<uint8_t> cells;
+    std::vector<uint8_t> next;
+    std::vector<std::vector<int>> changed; // Indices of changed cells, per row chunk
+
+    int threadCount = 0;
+    std::unique_ptr<Workers> workers; // Kept across generations, created on first parallel step
+};
@@ -4,11 +4,21 @@ Pong implementation using SimpleECS.
 Kewei Han
 */
 #include <SimpleECS_Core.h>
+#include "startup.h"
 #include <iostream>
 #include <cstdlib>
 #include <vector>
 #include <string>
 #include <memory>
+#include <unordered_map>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
 
 
 using namespace std;
@@ -25,12 +35,22 @@ const int SCREEN_HEIGHT		= 480;
 const int SCREEN_WIDTH		= 640;
 const int WALL_THICKNESS	= 50000;
 const int PADDLE_LENGTH		= 45;
+const int PADDLE_WIDTH		= 10;
+const int PADDLE_OFFSET		= 20;	// Distance of paddle center from screen edge
+const double PADDLE_SPEED	= 0.4;	// Pixels per millisecond
 
 // Ball parameters
+const int BALL_SIZE		= 10;
 const int MAX_Y_SPEED	= 600;
 const int MIN_Y_SPEED	= 400;
 const int X_SPEED		= 400;
 
+// Computer player parameters
+const double AI_DIFFICULTY	= 0.8;	// 0 to 1. Lower difficulty aims less accurately and moves slower
+
+// Audio parameters
+const int SOUND_MIN_INTERVAL_MS	= 30;	// Minimum time between plays of the same sound
+
 // Score tracking
 int p1Score = 0;
 int p2Score = 0;
@@ -41,6 +61,115 @@ Handle<FontRenderer> rightText;
 Scene* pongScene;
 Entity* ball;
 
+// Plays sound effects on a dedicated thread so collision callbacks never block on audio.
+// Requests are passed from game thread through a single producer, single consumer lock-free ring buffer.
+// The mixer thread sleeps while the queue is empty and is woken when a sound is queued.
+//
+// SoundPlayer::playAudio is called from the mixer thread. This relies on SDL_mixer's
+// Mix_PlayChannel locking the audio device itself, and on SimpleECS keeping SDL_mixer
+// open until startGame() returns, which is when main stops the mixer.
+class AudioMixer {
+public:
+	~AudioMixer() { stop(); }
+
+	void start()
+	{
+		running = true;
+		worker = std::thread(&AudioMixer::run, this);
+	}
+
+	void stop()
+	{
+		running = false;
+		{
+			std::lock_guard<std::mutex> lock(wakeMutex);
+		}
+		wakeup.notify_one();
+		if (worker.joinable())
+		{
+			worker.join();
+		}
+	}
+
+	// Queue sound to be played. Request is dropped if queue is full.
+	void play(SoundPlayer* sound)
+	{
+		size_t head = writeIndex.load(std::memory_order_relaxed);
+		size_t next = (head + 1) % QUEUE_SIZE;
+		if (next == readIndex.load(std::memory_order_acquire))
+		{
+			return;
+		}
+		queue[head] = sound;
+		writeIndex.store(next);
+
+		// Mutex is only taken while mixer thread is going to sleep, for at most the time
+		// it takes to re-check the queue. Sequentially consistent ordering of writeIndex and
+		// sleeping ensures either the mixer sees this sound or this call sees it sleeping.
+		if (sleeping)
+		{
+			{
+				std::lock_guard<std::mutex> lock(wakeMutex);
+			}
+			wakeup.notify_one();
+		}
+	}
+
+private:
+	void run()
+	{
+		while (running)
+		{
+			size_t tail = readIndex.load(std::memory_order_relaxed);
+			if (tail == writeIndex.load())
+			{
+				std::unique_lock<std::mutex> lock(wakeMutex);
+				sleeping = true;
+				wakeup.wait(lock, [this, tail]() { return !running || tail != writeIndex.load(); });
+				sleeping = false;
+				continue;
+			}
+			SoundPlayer* sound = queue[tail];
+			readIndex.store((tail + 1) % QUEUE_SIZE, std::memory_order_release);
+
+			// Rate limit each sound so bursts of contacts don't stack identical effects
+			auto now = std::chrono::steady_clock::now();
+			auto& last = lastPlayed[sound];
+			if (now - last >= std::chrono::milliseconds(SOUND_MIN_INTERVAL_MS))
+			{
+				last = now;
+				sound->playAudio();
+			}
+		}
+	}
+
+	static const size_t QUEUE_SIZE = 64;
+	std::array<SoundPlayer*, QUEUE_SIZE> queue{};
+	std::atomic<size_t> writeIndex{ 0 };
+	std::atomic<size_t> readIndex{ 0 };
+	std::atomic<bool> running{ false };
+	std::atomic<bool> sleeping{ false };
+	std::mutex wakeMutex;
+	std::condition_variable wakeup;
+	std::thread worker;
+	unordered_map<SoundPlayer*, std::chrono::steady_clock::time_point> lastPlayed;
+};
+
+// Sound effects by file path, loaded once and shared between components.
+// Declared before mixer so sounds outlive the audio thread.
+unordered_map<string, shared_ptr<SoundPlayer>> soundCache;
+AudioMixer audioMixer;
+
+shared_ptr<SoundPlayer> loadSound(const string& path)
+{
+	auto& sound = soundCache[path];
+	if (!sound)
+	{
+		sound = make_shared<SoundPlayer>(path);
+	}
+	return sound;
+}
+
 // PlayerTypes
 enum PlayerType {
 	PLAYER1,
@@ -53,71 +182,155 @@ enum PlayerType {
 Entity* createBall();
 void spawnBall();
 
-// Component for controlling paddle movement manually
+// Check if collider belongs to the live ball. Compares entity identity rather than tag strings.
+inline bool isBall(const Collider& other)
+{
+	return other.entity == ball;
+}
+
+// Predict ball y position when it reaches targetX, mirroring off top and bottom walls
+double predictInterceptY(const Vector& position, const Vector& velocity, double targetX)
+{
+	double time = (targetX - position.x) / velocity.x;
+	double unboundedY = position.y + velocity.y * time;
+
+	// Fold unbounded path back into playing field, every span travelled is one wall bounce
+	double minY = -SCREEN_HEIGHT / 2 + BALL_SIZE / 2;
+	double span = SCREEN_HEIGHT - BALL_SIZE;
+	double offset = fmod(unboundedY - minY, 2 * span);
+	if (offset < 0)
+	{
+		offset += 2 * span;
+	}
+	return offset <= span ? minY + offset : minY + 2 * span - offset;
+}
+
+// Component predicting where ball will reach the paddle it is heading toward. Prediction
+// is only recomputed when a collision turns the ball toward the other paddle. Wall bounces
+// are already part of the prediction and do not change it.
+class BallTracker : public Component {
+public:
+	static int heading;				// -1 if ball is heading toward left paddle, 1 if right
+	static double interceptY;		// Predicted ball y position at paddle it is heading toward
+	static int predictionCount;		// Incremented on every new prediction
+
+	void initialize() override
+	{
+		physics = entity->getComponent<PhysicsBody>();
+	}
+
+	void update() override
+	{
+		if (!trajectoryChanged || physics->velocity.x == 0)
+		{
+			return;
+		}
+		trajectoryChanged = false;
+
+		int newHeading = physics->velocity.x < 0 ? -1 : 1;
+		if (newHeading == predictedHeading)
+		{
+			return;
+		}
+		predictedHeading = newHeading;
+
+		heading = newHeading;
+		double interceptX = heading * (SCREEN_WIDTH / 2 - PADDLE_OFFSET - PADDLE_WIDTH / 2 - BALL_SIZE / 2);
+		interceptY = predictInterceptY(entity->transform->position, physics->velocity, interceptX);
+		predictionCount++;
+	}
+
+	void onCollide(const Collider&) override
+	{
+		trajectoryChanged = true;
+	}
+
+private:
+	bool trajectoryChanged = true;
+	int predictedHeading = 0;		// Heading of this ball's last prediction, 0 if none yet
+	Handle<PhysicsBody> physics;
+};
+
+int BallTracker::heading			= 0;
+double BallTracker::interceptY		= 0;
+int BallTracker::predictionCount	= 0;
+
+// Component for controlling paddle movement manually or by computer
 class PaddleController : public Component {
 public:
-	PaddleController(PlayerType player) : player(player) {};
+	PaddleController(PlayerType player, double difficulty = AI_DIFFICULTY) : player(player), difficulty(difficulty) {};
 	
 	void initialize() {}
 
-	// Apply computer control of paddle based on ball position
-	void aiControl(bool& downPressed, bool& upPressed)
+	// Get computer movement toward predicted ball intercept, or back to center if ball is heading away
+	double aiControl(double maxStep)
 	{
-		bool comp2Active = ball->transform->position.x > 0 && player == COMPUTER2;
-		bool comp1Active = ball->transform->position.x < 0 && player == COMPUTER1;
-		if (comp2Active || comp1Active)
+		int side = player == COMPUTER1 ? -1 : 1;
+		double target = 0;
+		if (BallTracker::heading == side)
 		{
-			if (ball->transform->position.y > entity->transform->position.y)
+			// Pick a new aim error once per approach of ball, scaled by difficulty
+			if (seenPrediction != BallTracker::predictionCount)
 			{
-				upPressed = true;
-				downPressed = false;
-			}
-			else
-			{
-				downPressed = true;
-				upPressed = false;
+				seenPrediction = BallTracker::predictionCount;
+				double maxError = (1 - difficulty) * PADDLE_LENGTH;
+				aimError = maxError * (2.0 * rand() / RAND_MAX - 1);
 			}
+			target = BallTracker::interceptY + aimError;
 		}
+
+		// Limit step so paddle settles on target instead of oscillating around it
+		maxStep *= 0.5 + 0.5 * difficulty;
+		return std::clamp(target - entity->transform->position.y, -maxStep, maxStep);
 	}
 
 	void update() override
 	{
-		// Determine control scheme for this controller
-		bool downPressed = player == PLAYER1 ?	Input::getKeyDown(KeyCode::KEY_S) :
-												Input::getKeyDown(KeyCode::KEY_DOWN_ARROW);
-		bool upPressed	= player == PLAYER1 ?	Input::getKeyDown(KeyCode::KEY_W) : 
-												Input::getKeyDown(KeyCode::KEY_UP_ARROW);
-		if(player == COMPUTER1 || player == COMPUTER2) 
-		{
-			aiControl(downPressed, upPressed);
-		}
+		double maxStep = PADDLE_SPEED * Timer::getDeltaTime();
+		double step = 0;
 
-		// Move paddle based on input and limit movement
-		if (upPressed && entity->transform->position.y < SCREEN_HEIGHT / 2 - PADDLE_LENGTH)
+		// Determine control scheme for this controller
+		if (player == COMPUTER1 || player == COMPUTER2)
 		{
-			entity->transform->position.y += 0.4 * Timer::getDeltaTime();
+			step = aiControl(maxStep);
 		}
-		else if (downPressed && entity->transform->position.y > -SCREEN_HEIGHT / 2 + PADDLE_LENGTH)
+		else
 		{
-			entity->transform->position.y -= 0.4 * Timer::getDeltaTime();
+			bool downPressed = player == PLAYER1 ?	Input::getKeyDown(KeyCode::KEY_S) :
+													Input::getKeyDown(KeyCode::KEY_DOWN_ARROW);
+			bool upPressed	= player == PLAYER1 ?	Input::getKeyDown(KeyCode::KEY_W) : 
+													Input::getKeyDown(KeyCode::KEY_UP_ARROW);
+			step = upPressed ? maxStep : downPressed ? -maxStep : 0;
 		}
+
+		// Move paddle and limit movement
+		double limit = SCREEN_HEIGHT / 2 - PADDLE_LENGTH;
+		entity->transform->position.y = std::clamp(entity->transform->position.y + step, -limit, limit);
 	}
 
 private:
 	PlayerType player;
+	double difficulty;
+	double aimError = 0;
+	int seenPrediction = -1;
 };
 
-// Component for registering score
+// Component for registering score and playing score sound effect
 class BoundScoreRegister : public Component {
 public: 
-	BoundScoreRegister(PlayerType player) : player(player) {}
+	BoundScoreRegister(PlayerType player, std::string pathToEffect) : player(player) {
+		sound = loadSound(pathToEffect);
+	}
 	void update() override {}
 	void initialize() override {}
 	void onCollide(const Collider& other) override
 	{
 		// Ball has collided. 
-		if (other.entity->tag == "ball")
+		if (isBall(other))
 		{
+			// Play before ball is replaced, other sound components would no longer see it as ball
+			audioMixer.play(sound.get());
+
 			//Destroy ball
 			pongScene->destroyEntity(other.entity->id);
 
@@ -139,21 +352,22 @@ public:
 	}
 
 	PlayerType player;
+	shared_ptr<SoundPlayer> sound;
 };
 
 // Component for playing a sound effect on collision
 class CollideSoundEffect : public Component {
 public:
 	CollideSoundEffect(std::string pathToEffect) {
-		sound = make_shared<SoundPlayer>(pathToEffect);
+		sound = loadSound(pathToEffect);
 	}
 	void update() override {}
 	void initialize() override {}
 	void onCollide(const Collider& other) override
 	{
-		if (other.entity->tag == "ball")
+		if (isBall(other))
 		{
-			sound->playAudio();
+			audioMixer.play(sound.get());
 		}
 	}
 
@@ -166,13 +380,13 @@ Entity* createPaddle(PlayerType player)
 	// Create paddle and add to scene
 	Entity* paddle = pongScene->createEntity();
 
-	paddle->addComponent<RectangleRenderer>(10, PADDLE_LENGTH, Color(0xFF, 0xFF, 0xFF));
+	paddle->addComponent<RectangleRenderer>(PADDLE_WIDTH, PADDLE_LENGTH, Color(0xFF, 0xFF, 0xFF));
 	paddle->addComponent<PaddleController>(player);
-	paddle->addComponent<BoxCollider>(10, PADDLE_LENGTH);
+	paddle->addComponent<BoxCollider>(PADDLE_WIDTH, PADDLE_LENGTH);
 	paddle->addComponent<CollideSoundEffect>(SOUND_PADDLE);
 
 	// Position differently based on player
-	paddle->transform->position.x = player == PLAYER1 || player == COMPUTER1 ? -SCREEN_WIDTH / 2 + 20 : SCREEN_WIDTH / 2 - 20;
+	paddle->transform->position.x = player == PLAYER1 || player == COMPUTER1 ? -SCREEN_WIDTH / 2 + PADDLE_OFFSET : SCREEN_WIDTH / 2 - PADDLE_OFFSET;
 
 	return paddle;
 }
@@ -182,9 +396,10 @@ Entity* createBall()
 {
 	Entity* newBall = pongScene->createEntity("ball");
 
-	newBall->addComponent<RectangleRenderer>(10, 10, Color(0xFF, 0xFF, 0xFF, 0xFF));
-	newBall->addComponent<BoxCollider>(10, 10);
+	newBall->addComponent<RectangleRenderer>(BALL_SIZE, BALL_SIZE, Color(0xFF, 0xFF, 0xFF, 0xFF));
+	newBall->addComponent<BoxCollider>(BALL_SIZE, BALL_SIZE);
 	Handle<PhysicsBody> physics = newBall->addComponent<PhysicsBody>();
+	newBall->addComponent<BallTracker>();
 
 	// Randomize direction and speed
 	int direction = rand() % 2 == 0 ? -1 : 1;
@@ -208,8 +423,7 @@ Entity* createSideWalls(PlayerType player)
 {
 	Entity* wall = pongScene->createEntity();
 	wall->addComponent<BoxCollider>(WALL_THICKNESS, SCREEN_HEIGHT + WALL_THICKNESS);
-	wall->addComponent<BoundScoreRegister>(player);
-	wall->addComponent<CollideSoundEffect>(SOUND_SCORE);
+	wall->addComponent<BoundScoreRegister>(player, SOUND_SCORE);
 	return wall;
 }
 
@@ -261,7 +475,7 @@ void spawnBall()
 
 int main() {
 	cout << "Hello World!" << endl;
-	
+
 	// Create scene
 	pongScene = new Scene(Color(0, 0, 0, 255));
 
@@ -272,6 +486,8 @@ int main() {
 	createPaddle(COMPUTER1);
 	createPaddle(COMPUTER2);
 	spawnBall();
+	pongScene->createEntity()->addComponent<FirstFrameLogger>();
+	logStartupStage("Scene populated");
 
 	// Create game with scene
 	Game::getInstance().configureWindow(SCREEN_WIDTH, SCREEN_HEIGHT);
@@ -279,5 +495,7 @@ int main() {
 	Game::getInstance().addScene(pongScene);
 
 	// Start game loop
+	audioMixer.start();
 	Game::getInstance().startGame();
+	audioMixer.stop();
 }
\ No newline at end of file
@@ -0,0 +1,36 @@
+/*
+Startup timing shared by the game scripts.
+*/
+#pragma once
+#include <SimpleECS_Core.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+inline const auto startupBegin = std::chrono::steady_clock::now();
+
+// Print time taken by a startup stage, and total time since program start
+inline void logStartupStage(const std::string& stage)
+{
+    using namespace std::chrono;
+    static auto stageBegin = startupBegin;
+    auto now = steady_clock::now();
+    std::cout << "[Startup] " << stage << ": " << duration_cast<milliseconds>(now - stageBegin).count() << " ms"
+        << " (total " << duration_cast<milliseconds>(now - startupBegin).count() << " ms)" << std::endl;
+    stageBegin = now;
+}
+
+// Component logging startup time once the first frame is updated
+class FirstFrameLogger : public SimpleECS::Component {
+public:
+    void update() override
+    {
+        if (!logged)
+        {
+            logStartupStage("First frame");
+            logged = true;
+        }
+    }
+
+    bool logged = false;
+};
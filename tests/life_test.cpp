@@ -0,0 +1,386 @@
+/*
+Tests of cellular automaton rules, RLE pattern parsing and grid stepping.
+*/
+#include <gtest/gtest.h>
+#include "life.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Cells of grid as rows of states, for comparing whole grids
+static std::vector<std::vector<uint8_t>> snapshot(const LifeGrid& grid)
+{
+    std::vector<std::vector<uint8_t>> cells(grid.rows, std::vector<uint8_t>(grid.cols));
+    for (int r = 0; r < grid.rows; ++r)
+    {
+        for (int c = 0; c < grid.cols; ++c)
+        {
+            cells[r][c] = grid.get(r, c);
+        }
+    }
+    return cells;
+}
+
+static RLEPattern parseRLEText(const std::string& text)
+{
+    std::istringstream in(text);
+    return parseRLE(in);
+}
+
+// Place pattern into grid with its bottom left cell at (r, c)
+static void place(LifeGrid& grid, const RLEPattern& pattern, int r, int c)
+{
+    for (size_t i = 0; i < pattern.cells.size(); ++i)
+    {
+        for (size_t j = 0; j < pattern.cells[i].size(); ++j)
+        {
+            grid.set(r + static_cast<int>(i), c + static_cast<int>(j), pattern.cells[i][j]);
+        }
+    }
+}
+
+// Grid of random live and dead cells under rule, seeded for repeatable runs
+static LifeGrid randomGrid(int size, const std::string& rule)
+{
+    LifeGrid grid(size, size);
+    grid.setRule(parseRule(rule));
+    std::mt19937 rng(1);
+    for (int r = 0; r < size; ++r)
+    {
+        for (int c = 0; c < size; ++c)
+        {
+            grid.set(r, c, rng() % 3 == 0);
+        }
+    }
+    return grid;
+}
+
+// Next generation computed by counting every neighbor directly, as reference for kernels
+static std::vector<std::vector<uint8_t>> naiveStep(const LifeGrid& grid)
+{
+    const LifeRule& rule = grid.getRule();
+    int n = grid.rows;
+    std::vector<std::vector<uint8_t>> next(n, std::vector<uint8_t>(grid.cols));
+    for (int r = 0; r < n; ++r)
+    {
+        for (int c = 0; c < grid.cols; ++c)
+        {
+            int count = 0;
+            for (int dr = -rule.range; dr <= rule.range; ++dr)
+            {
+                for (int dc = -rule.range; dc <= rule.range; ++dc)
+                {
+                    bool outside = rule.vonNeumann && std::abs(dr) + std::abs(dc) > rule.range;
+                    bool self = dr == 0 && dc == 0 && !rule.countMiddle;
+                    if (!outside && !self)
+                    {
+                        count += grid.get(((r + dr) % n + n) % n, ((c + dc) % grid.cols + grid.cols) % grid.cols) == 1;
+                    }
+                }
+            }
+
+            int state = grid.get(r, c);
+            if (state == 0)
+            {
+                next[r][c] = rule.birth[count];
+            }
+            else if (state == 1)
+            {
+                next[r][c] = rule.survive[count] ? 1 : (rule.states > 2 ? 2 : 0);
+            }
+            else
+            {
+                next[r][c] = state + 1 < rule.states ? state + 1 : 0;
+            }
+        }
+    }
+    return next;
+}
+
+// RLE parser as it was before rule support, kept as reference for 2 state patterns
+static std::vector<std::vector<bool>> referenceParseRLE(std::istream& file)
+{
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line[0] == 'x') {
+            break;
+        }
+    }
+
+    std::vector<std::vector<bool>> grid;
+    std::string cellData;
+    while (std::getline(file, cellData, '$')) {
+        int numEmpties = 0;
+        if (isdigit(cellData.back())) {
+            numEmpties = cellData.back() - '0' - 1;
+            cellData.pop_back();
+        }
+
+        if (!cellData.empty()) {
+            std::vector<bool> row;
+            int count = 0;
+            for (char c : cellData) {
+                if (isdigit(c)) {
+                    count = count * 10 + (c - '0');
+                }
+                else {
+                    if (c == '!') { break; }
+                    if (c == '\n') { continue; }
+                    row.insert(row.end(), std::max(1, count), c == 'o');
+                    count = 0;
+                }
+            }
+            grid.push_back(row);
+        }
+
+        for (int i = 0; i < numEmpties; ++i) {
+            grid.push_back(std::vector<bool>());
+        }
+    }
+
+    std::reverse(grid.begin(), grid.end());
+    return grid;
+}
+
+TEST(ParseRule, LifeRule)
+{
+    LifeRule rule = parseRule("B3/S23");
+    EXPECT_EQ(rule.states, 2);
+    EXPECT_EQ(rule.range, 1);
+    EXPECT_FALSE(rule.vonNeumann);
+    EXPECT_FALSE(rule.countMiddle);
+    EXPECT_EQ(rule.maxNeighbors(), 8);
+    for (int n = 0; n <= 8; ++n)
+    {
+        EXPECT_EQ(rule.birth[n], n == 3) << n;
+        EXPECT_EQ(rule.survive[n], n == 2 || n == 3) << n;
+    }
+}
+
+TEST(ParseRule, GenerationsStates)
+{
+    EXPECT_EQ(parseRule("B2/S/C3").states, 3);
+    EXPECT_EQ(parseRule("/2/3").states, 3);
+    EXPECT_EQ(parseRule("345/2/4").states, 4);
+}
+
+TEST(ParseRule, LargerThanLife)
+{
+    LifeRule rule = parseRule("R5,C0,M1,S34..58,B34..45,NM");
+    EXPECT_EQ(rule.range, 5);
+    EXPECT_EQ(rule.states, 2);
+    EXPECT_TRUE(rule.countMiddle);
+    EXPECT_FALSE(rule.vonNeumann);
+    EXPECT_EQ(rule.maxNeighbors(), 120);
+    EXPECT_TRUE(rule.survive[34] && rule.survive[58] && !rule.survive[59]);
+    EXPECT_TRUE(rule.birth[34] && rule.birth[45] && !rule.birth[33]);
+
+    EXPECT_EQ(parseRule("R2,C0,M0,S1..2,B2,NN").maxNeighbors(), 12);
+    EXPECT_EQ(parseRule("R500,C0,M0,S1,B1,NM").maxNeighbors(), 1001 * 1001 - 1);
+}
+
+TEST(ParseRule, LifeNotationsAgree)
+{
+    const std::vector<std::string> notations = {
+        "b3/s23", "23/3", "S23/B3", "B3/S23/2", "B3/S23/C2",
+        "R1,C0,M0,S2..3,B3..3,NM", "R1,C2,M1,S3..4,B3,NM", "r1,c0,m1,s3,4,b3..3,nm",
+    };
+
+    LifeGrid life = randomGrid(97, "B3/S23");
+    std::vector<LifeGrid> grids;
+    for (const auto& notation : notations)
+    {
+        grids.push_back(randomGrid(97, notation));
+    }
+
+    for (int step = 0; step < 60; ++step)
+    {
+        life.step();
+        for (size_t i = 0; i < grids.size(); ++i)
+        {
+            grids[i].step();
+            ASSERT_EQ(snapshot(grids[i]), snapshot(life)) << notations[i] << " at step " << step;
+        }
+    }
+}
+
+TEST(ParseRule, RejectsMalformed)
+{
+    const std::vector<std::string> malformed = {
+        "", "X3", "B9/S23", "B3//S2", "B3/S2a", "1/2/3/4", "B3/S23/C1", "B3/S23/C300",
+        "R0,C0,M0,S1,B1,NM", "R2,Q1", "R2,NX", "R1,C0,M0,S9,B3,NM", "R1,C0,M0,S1..,B3,NM",
+        "R30000,C0,M0,S1,B1,NM", "R99999999999", "R501,C0,M0,S1,B1,NM",
+    };
+    for (const auto& rule : malformed)
+    {
+        EXPECT_THROW(parseRule(rule), std::invalid_argument) << rule;
+    }
+}
+
+TEST(ParseRLE, HeaderAndCells)
+{
+    // Glider, top row first in RLE
+    RLEPattern pattern = parseRLEText("#N Glider\nx = 3, y = 3, rule = B36/S23\nbob$2bo$3o!\n");
+    EXPECT_TRUE(pattern.rule.birth[6]);
+    ASSERT_EQ(pattern.cells.size(), 3u);
+
+    // Bottom row first once parsed
+    std::vector<std::vector<uint8_t>> expected = { {1, 1, 1}, {0, 0, 1}, {0, 1, 0} };
+    EXPECT_EQ(pattern.cells, expected);
+}
+
+TEST(ParseRLE, DefaultsAndPadding)
+{
+    // No rule given, multi-digit row skip, trailing dead cells omitted
+    RLEPattern pattern = parseRLEText("x = 4, y = 13\no12$3o!");
+    EXPECT_EQ(pattern.rule.states, 2);
+    EXPECT_TRUE(pattern.rule.birth[3]);
+    ASSERT_EQ(pattern.cells.size(), 13u);
+    EXPECT_EQ(pattern.cells.back(), std::vector<uint8_t>({ 1, 0, 0, 0 }));
+    EXPECT_EQ(pattern.cells.front(), std::vector<uint8_t>({ 1, 1, 1, 0 }));
+    EXPECT_EQ(pattern.cells[1], std::vector<uint8_t>(4, 0));
+}
+
+TEST(ParseRLE, MultiState)
+{
+    RLEPattern pattern = parseRLEText("x = 3, y = 1, rule = B2/S/C3\n.AB!");
+    ASSERT_EQ(pattern.cells.size(), 1u);
+    EXPECT_EQ(pattern.cells[0], std::vector<uint8_t>({ 0, 1, 2 }));
+}
+
+TEST(ParseRLE, MatchesReferenceParser)
+{
+    std::ifstream file(PONG_ASSETS_DIR "/rats.rle");
+    ASSERT_TRUE(file.is_open());
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+
+    std::istringstream patternIn(buffer.str());
+    std::istringstream referenceIn(buffer.str());
+    RLEPattern pattern = parseRLE(patternIn);
+    std::vector<std::vector<bool>> reference = referenceParseRLE(referenceIn);
+
+    // Reference leaves rows unpadded, parsed rows are padded with dead cells
+    ASSERT_EQ(pattern.cells.size(), reference.size());
+    for (size_t r = 0; r < reference.size(); ++r)
+    {
+        for (size_t c = 0; c < pattern.cells[r].size(); ++c)
+        {
+            bool expected = c < reference[r].size() && reference[r][c];
+            ASSERT_EQ(pattern.cells[r][c], expected) << r << "," << c;
+        }
+    }
+}
+
+TEST(ParseRLE, RejectsMalformedRule)
+{
+    EXPECT_THROW(parseRLEText("x = 1, y = 1, rule = B9/S23\no!"), std::invalid_argument);
+    EXPECT_THROW(parseRLE(std::string("does/not/exist.rle")), std::runtime_error);
+}
+
+class KernelTest : public ::testing::TestWithParam<std::string> {};
+
+TEST_P(KernelTest, MatchesNaiveCount)
+{
+    LifeGrid grid = randomGrid(61, GetParam());
+    for (int step = 0; step < 8; ++step)
+    {
+        auto expected = naiveStep(grid);
+        grid.step();
+        ASSERT_EQ(snapshot(grid), expected) << "step " << step;
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Rules, KernelTest, ::testing::Values(
+    "B3/S23", "23/3", "B36/S23", "B2/S/C3", "/2/3", "345/2/4",
+    "R5,C0,M1,S34..58,B34..45,NM", "R2,C3,M0,S3..5,B4..5,NN", "R3,C0,M1,S4..9,B5..8,NN"));
+
+TEST(LifeGrid, ThreadCountDoesNotChangeResult)
+{
+    for (const std::string rule : { "B3/S23", "B2/S/C3", "R3,C0,M1,S8..14,B9..12,NN" })
+    {
+        LifeGrid single = randomGrid(67, rule);
+        single.setThreadCount(1);
+        std::vector<LifeGrid> grids;
+        for (int threads : { 2, 3, 8, 100 })
+        {
+            grids.push_back(randomGrid(67, rule));
+            grids.back().setThreadCount(threads);
+        }
+
+        for (int step = 0; step < 20; ++step)
+        {
+            single.step();
+            std::vector<int> singleChanged;
+            single.forEachChanged([&](int i, uint8_t) { singleChanged.push_back(i); });
+
+            for (size_t i = 0; i < grids.size(); ++i)
+            {
+                grids[i].step();
+                ASSERT_EQ(snapshot(grids[i]), snapshot(single)) << rule << " grid " << i << " at step " << step;
+
+                std::vector<int> gridChanged;
+                grids[i].forEachChanged([&](int j, uint8_t) { gridChanged.push_back(j); });
+                ASSERT_EQ(gridChanged, singleChanged) << rule << " grid " << i << " at step " << step;
+            }
+        }
+    }
+}
+
+TEST(LifeGrid, StatesOutsideRuleAreLive)
+{
+    LifeGrid grid(4, 4);
+    grid.set(0, 0, 5);
+    EXPECT_EQ(grid.get(0, 0), 1);
+
+    grid.setRule(parseRule("B2/S/C8"));
+    grid.set(1, 1, 5);
+    EXPECT_EQ(grid.get(1, 1), 5);
+
+    grid.setRule(parseRule("B3/S23"));
+    EXPECT_EQ(grid.get(1, 1), 1);
+}
+
+TEST(LifeGrid, BlinkerOscillates)
+{
+    LifeGrid grid(5, 5);
+    grid.set(2, 1, 1);
+    grid.set(2, 2, 1);
+    grid.set(2, 3, 1);
+    auto start = snapshot(grid);
+
+    grid.step();
+    EXPECT_EQ(grid.get(1, 2), 1);
+    EXPECT_EQ(grid.get(3, 2), 1);
+    EXPECT_EQ(grid.get(2, 1), 0);
+
+    int changedCount = 0;
+    grid.forEachChanged([&](int, uint8_t) { changedCount++; });
+    EXPECT_EQ(changedCount, 4);
+
+    grid.step();
+    EXPECT_EQ(snapshot(grid), start);
+}
+
+TEST(LifeGrid, GliderWrapsAroundTorus)
+{
+    // A glider returns to its starting cells after 4 steps per cell of grid width
+    LifeGrid grid(8, 8);
+    place(grid, parseRLEText("x = 3, y = 3\nbob$2bo$3o!"), 0, 0);
+    auto start = snapshot(grid);
+
+    for (int i = 0; i < 4 * 8; ++i)
+    {
+        grid.step();
+        if (i == 3)
+        {
+            EXPECT_NE(snapshot(grid), start);
+        }
+    }
+    EXPECT_EQ(snapshot(grid), start);
+}